@@ -0,0 +1,100 @@
+#include "capture_file.h"
+
+#include <cstring>
+
+static const char MAGIC[8] = {'S', 'W', 'C', 'A', 'P', '1', '\n', '\0'};
+
+static void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+static bool get_varint(std::istream& in, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == std::char_traits<char>::eof()) return false;
+        v |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool CaptureWriter::open(const std::string& path, uint64_t start_wall_ns) {
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) return false;
+    std::string header(MAGIC, sizeof(MAGIC));
+    for (int i = 0; i < 8; ++i)
+        header.push_back(static_cast<char>(start_wall_ns >> (8 * i)));
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    last_ns_ = 0;
+    records_ = 0;
+    return static_cast<bool>(out_);
+}
+
+bool CaptureWriter::write(uint64_t t_ns, CaptureChannel channel,
+                          const char* data, size_t len) {
+    std::string prefix;
+    put_varint(prefix, t_ns >= last_ns_ ? t_ns - last_ns_ : 0);
+    prefix.push_back(static_cast<char>(channel));
+    put_varint(prefix, len);
+    out_.write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+    out_.write(data, static_cast<std::streamsize>(len));
+    if (t_ns > last_ns_) last_ns_ = t_ns;
+    ++records_;
+    return static_cast<bool>(out_);
+}
+
+bool CaptureWriter::close() {
+    out_.flush();
+    bool ok = static_cast<bool>(out_);
+    out_.close();
+    return ok;
+}
+
+bool load_capture(const std::string& path, std::vector<CaptureRecord>& records,
+                  uint64_t* start_wall_ns) {
+    // Records are read one at a time straight into their own strings, so a
+    // multi-gigabyte capture is held in memory once, not twice.
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const auto file_size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+
+    char header[16];
+    if (!in.read(header, sizeof(header)) ||
+        std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+
+    if (start_wall_ns) {
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<uint64_t>(static_cast<unsigned char>(header[8 + i])) << (8 * i);
+        *start_wall_ns = v;
+    }
+
+    records.clear();
+    uint64_t t = 0;
+    while (in.peek() != std::char_traits<char>::eof()) {
+        uint64_t delta, len;
+        if (!get_varint(in, delta)) return false;
+        int raw = in.get();
+        if (raw == std::char_traits<char>::eof() ||
+            raw > static_cast<int>(CaptureChannel::Control))
+            return false;
+        // Check the length against what is left before allocating for it.
+        if (!get_varint(in, len) ||
+            len > file_size - static_cast<uint64_t>(in.tellg()))
+            return false;
+        t += delta;
+        records.push_back(CaptureRecord{t, static_cast<CaptureChannel>(raw),
+                                        std::string(len, '\0')});
+        if (len > 0 && !in.read(&records.back().bytes[0],
+                                static_cast<std::streamsize>(len)))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Compact on-disk format for captured multicast traffic.
+//
+//   header: "SWCAP1\n\0" (8 bytes), uint64 LE wall-clock ns at capture start
+//   record: varint ns since the previous record, uint8 channel,
+//           varint length, payload bytes
+//
+// Delta-encoded timestamps keep the per-record overhead to a few bytes.
+
+enum class CaptureChannel : uint8_t { Payload = 0, Control = 1 };
+
+struct CaptureRecord {
+    uint64_t       t_ns{0}; // arrival time, ns since capture start
+    CaptureChannel channel{CaptureChannel::Payload};
+    std::string    bytes;
+};
+
+class CaptureWriter {
+public:
+    // Create (truncate) path and write the header. Returns false on error.
+    bool open(const std::string& path, uint64_t start_wall_ns);
+
+    // Append one datagram. A t_ns below the previous record's is stored as
+    // equal to it, so records stay in write order.
+    bool write(uint64_t t_ns, CaptureChannel channel,
+               const char* data, size_t len);
+
+    bool close();
+
+    uint64_t records() const { return records_; }
+
+private:
+    std::ofstream out_;
+    uint64_t      last_ns_{0};
+    uint64_t      records_{0};
+};
+
+// Read a whole capture into memory. Returns false if the file is missing,
+// has a bad header or ends mid-record.
+bool load_capture(const std::string& path, std::vector<CaptureRecord>& records,
+                  uint64_t* start_wall_ns = nullptr);
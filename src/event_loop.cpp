@@ -0,0 +1,198 @@
+#include "event_loop.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+static constexpr int MAX_EVENTS = 64;
+
+EventLoop::EventLoop(EventLoopOptions opts)
+    : opts_(opts)
+{
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "[EventLoop] setup failed: " << std::strerror(errno) << '\n';
+        return;
+    }
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    if (wake_fd_ >= 0)  ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+}
+
+bool EventLoop::add_fd(int fd, FdCallback cb) {
+    if (epoll_fd_ < 0 || fd < 0) return false;
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+    fd_callbacks_[fd] = std::make_shared<FdCallback>(std::move(cb));
+    return true;
+}
+
+void EventLoop::remove_fd(int fd) {
+    if (fd_callbacks_.erase(fd) == 0) return;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+TimerId EventLoop::add_timer(std::chrono::milliseconds delay, TimerCallback cb) {
+    TimerId id = next_timer_id_++;
+    auto deadline = Clock::now() + delay;
+    timers_[id] = Timer{deadline, std::chrono::milliseconds(0), std::move(cb)};
+    timer_heap_.emplace(deadline, id);
+    return id;
+}
+
+TimerId EventLoop::add_periodic_timer(std::chrono::milliseconds interval,
+                                      TimerCallback cb) {
+    TimerId id = next_timer_id_++;
+    auto deadline = Clock::now() + interval;
+    timers_[id] = Timer{deadline, interval, std::move(cb)};
+    timer_heap_.emplace(deadline, id);
+    return id;
+}
+
+void EventLoop::cancel_timer(TimerId id) {
+    // The heap entry is left behind and skipped when it reaches the top.
+    timers_.erase(id);
+}
+
+void EventLoop::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        posted_.push_back(std::move(fn));
+    }
+    wake();
+}
+
+void EventLoop::run() {
+    running_ = true;
+    pin_current_thread();
+    loop();
+}
+
+void EventLoop::start_thread() {
+    if (thread_.joinable()) return;
+    running_ = true;
+    thread_ = std::thread([this]{
+        pin_current_thread();
+        loop();
+    });
+}
+
+void EventLoop::stop() {
+    running_ = false;
+    wake();
+    if (thread_.joinable() && !in_loop_thread()) thread_.join();
+}
+
+bool EventLoop::in_loop_thread() const {
+    return loop_thread_id_.load() == std::this_thread::get_id();
+}
+
+void EventLoop::loop() {
+    loop_thread_id_ = std::this_thread::get_id();
+    epoll_event events[MAX_EVENTS];
+
+    while (running_) {
+        run_posted();
+        int timeout = run_timers();
+        if (!running_) break;
+        if (opts_.busy_poll) timeout = 0;
+
+        int n = ::epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[EventLoop] epoll_wait: " << std::strerror(errno) << '\n';
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) { drain_wakeup(); continue; }
+            // An earlier callback in this batch may have removed fd.
+            auto it = fd_callbacks_.find(fd);
+            if (it == fd_callbacks_.end()) continue;
+            auto cb = it->second;
+            (*cb)();
+        }
+    }
+    loop_thread_id_ = std::thread::id();
+}
+
+void EventLoop::wake() {
+    if (wake_fd_ < 0) return;
+    uint64_t one = 1;
+    ssize_t r = ::write(wake_fd_, &one, sizeof(one));
+    (void)r; // EAGAIN means a wake-up is already pending.
+}
+
+void EventLoop::drain_wakeup() {
+    uint64_t v;
+    while (::read(wake_fd_, &v, sizeof(v)) > 0) {}
+}
+
+void EventLoop::run_posted() {
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        if (posted_.empty()) return;
+        tasks.swap(posted_);
+    }
+    for (auto& fn : tasks) fn();
+}
+
+int EventLoop::run_timers() {
+    while (!timer_heap_.empty()) {
+        auto [deadline, id] = timer_heap_.top();
+        auto it = timers_.find(id);
+        if (it == timers_.end() || it->second.deadline != deadline) {
+            timer_heap_.pop(); // cancelled or rescheduled
+            continue;
+        }
+
+        auto now = Clock::now();
+        if (deadline > now) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            deadline - now).count();
+            return static_cast<int>(wait) + 1; // round up; never spin early
+        }
+
+        timer_heap_.pop();
+        TimerCallback cb = it->second.cb;
+        if (it->second.interval.count() > 0) {
+            auto next = deadline + it->second.interval;
+            if (next <= now) next = now + it->second.interval; // fell behind
+            it->second.deadline = next;
+            timer_heap_.emplace(next, id);
+        } else {
+            timers_.erase(it);
+        }
+        cb();
+    }
+    return -1;
+}
+
+void EventLoop::pin_current_thread() {
+    if (opts_.cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(opts_.cpu, &set);
+    int rc = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        std::cerr << "[EventLoop] failed to pin to cpu " << opts_.cpu
+                  << ": " << std::strerror(rc) << '\n';
+    }
+}
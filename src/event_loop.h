@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Invoked on the loop thread when a registered descriptor becomes readable.
+using FdCallback    = std::function<void()>;
+using TimerCallback = std::function<void()>;
+using TimerId       = uint64_t;
+
+struct EventLoopOptions {
+    // Spin on epoll_wait(0) instead of sleeping in the kernel. Trades one
+    // fully-used core for the lowest wake-up latency.
+    bool busy_poll{false};
+    // CPU to pin the loop thread to, or -1 to leave affinity alone.
+    int  cpu{-1};
+    // SO_BUSY_POLL budget (microseconds) applied to UDP sockets in
+    // busy-poll mode; 0 leaves the socket option untouched.
+    int  socket_busy_poll_usec{50};
+};
+
+// Single-threaded epoll reactor. Descriptors, timers and posted tasks all
+// run on the thread that calls run(); stop() and post() may be called from
+// any thread and wake the loop through an eventfd. add_fd/remove_fd and the
+// timer calls must be made on the loop thread or before run() starts.
+class EventLoop {
+public:
+    explicit EventLoop(EventLoopOptions opts = {});
+    ~EventLoop();
+
+    EventLoop(const EventLoop&)            = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    const EventLoopOptions& options() const { return opts_; }
+
+    // Watch fd for readability (level-triggered). Returns false on failure.
+    bool add_fd(int fd, FdCallback cb);
+
+    // Stop watching fd. Safe to call from within fd's own callback.
+    void remove_fd(int fd);
+
+    // Run cb once after delay. Returns an id usable with cancel_timer().
+    TimerId add_timer(std::chrono::milliseconds delay, TimerCallback cb);
+
+    // Run cb every interval, first firing one interval from now.
+    TimerId add_periodic_timer(std::chrono::milliseconds interval,
+                               TimerCallback cb);
+
+    // Cancel a pending timer; unknown or already-fired ids are ignored.
+    void cancel_timer(TimerId id);
+
+    // Queue fn to run on the loop thread. Thread-safe.
+    void post(std::function<void()> fn);
+
+    // Dispatch events on the calling thread until stop() is called.
+    void run();
+
+    // Start run() on a dedicated thread (pinned if opts.cpu >= 0).
+    void start_thread();
+
+    // Ask the loop to exit and join the loop thread if start_thread() was used.
+    void stop();
+
+    bool in_loop_thread() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        Clock::time_point          deadline;
+        std::chrono::milliseconds  interval{0}; // 0 = one-shot
+        TimerCallback              cb;
+    };
+
+    void loop();
+    void wake();
+    void drain_wakeup();
+    void run_posted();
+    // Fire due timers; returns the epoll timeout (ms) until the next one.
+    int  run_timers();
+    void pin_current_thread();
+
+    EventLoopOptions opts_;
+    int epoll_fd_{-1};
+    int wake_fd_{-1};
+
+    std::atomic<bool> running_{false};
+    std::thread       thread_;
+    std::atomic<std::thread::id> loop_thread_id_{};
+
+    // shared_ptr so a callback can remove its own fd while it is running.
+    std::unordered_map<int, std::shared_ptr<FdCallback>> fd_callbacks_;
+
+    TimerId next_timer_id_{1};
+    std::map<TimerId, Timer> timers_;
+    // (deadline, id) min-heap; entries whose id is gone from timers_ or whose
+    // deadline no longer matches are stale and skipped.
+    using HeapEntry = std::pair<Clock::time_point, TimerId>;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+                        std::greater<HeapEntry>> timer_heap_;
+
+    std::mutex                         post_mutex_;
+    std::vector<std::function<void()>> posted_;
+};
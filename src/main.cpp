@@ -8,14 +8,23 @@
 static void usage(const char* prog) {
     std::cerr << "Usage: " << prog
               << " <node_id> <zmq_bind_addr> <payload_mcast_addr>"
-                 " <payload_mcast_port> <ctrl_mcast_addr> <ctrl_mcast_port>\n"
+                 " <payload_mcast_port> <ctrl_mcast_addr> <ctrl_mcast_port>"
+                 " [--busy-poll] [--cpu=<n>] [--rate=<msgs/s>] [--burst=<n>]\n"
+              << "\nOptions:\n"
+              << "  --busy-poll  spin the event loop and enable SO_BUSY_POLL"
+                 " (lowest latency, burns one core)\n"
+              << "  --cpu=<n>    pin the event loop thread to CPU n\n"
+              << "  --rate=<r>   pace publishing to at most r messages/s, adapting"
+                 " to receiver feedback (default: unpaced)\n"
+              << "  --burst=<n>  messages allowed back-to-back when paced"
+                 " (default: 64)\n"
               << "\nExample:\n"
               << "  " << prog
               << " node1 tcp://*:5555 239.0.0.1 5000 239.0.0.2 5001\n";
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 7) { usage(argv[0]); return 1; }
+    if (argc < 7) { usage(argv[0]); return 1; }
 
     const std::string node_id           = argv[1];
     const std::string zmq_bind_addr     = argv[2];
@@ -24,14 +33,33 @@ int main(int argc, char* argv[]) {
     const std::string ctrl_mcast        = argv[5];
     const int         ctrl_port         = std::stoi(argv[6]);
 
+    EventLoopOptions   loop_opts;
+    FlowControlOptions flow_opts;
+    for (int i = 7; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--busy-poll") {
+            loop_opts.busy_poll = true;
+        } else if (arg.rfind("--cpu=", 0) == 0) {
+            loop_opts.cpu = std::stoi(arg.substr(6));
+        } else if (arg.rfind("--rate=", 0) == 0) {
+            flow_opts.rate = std::stod(arg.substr(7));
+        } else if (arg.rfind("--burst=", 0) == 0) {
+            flow_opts.burst = std::stod(arg.substr(8));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
     SpiderwebNode node(node_id, zmq_bind_addr,
                        payload_mcast, payload_port,
-                       ctrl_mcast, ctrl_port);
+                       ctrl_mcast, ctrl_port, loop_opts, flow_opts);
     node.start();
     LOG_S(INFO) << "Node '" << node_id << "' started.";
 
     std::cout << "[spiderweb] Node '" << node_id << "' started.\n"
-              << "Commands: publish <topic> <text>  |  peers  |  quit\n";
+              << "Commands: publish <topic> <text>  |  subscribe <pattern>  |"
+                 "  unsubscribe <id>  |  peers  |  quit\n";
 
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -50,6 +78,27 @@ int main(int argc, char* argv[]) {
                 for (auto& [id, addr] : p)
                     std::cout << "  " << id << "  ->  " << addr << '\n';
             }
+        } else if (cmd == "subscribe") {
+            std::string pattern;
+            iss >> pattern;
+            SubscriptionId id = node.subscribe(pattern,
+                [](const transport::Envelope& env, const SharedBuffer&) {
+                    std::cout << "[recv] topic=" << env.topic()
+                              << " seq=" << env.seq()
+                              << " payload=\"" << env.payload().value() << "\"\n";
+                });
+            if (id == 0) {
+                std::cerr << "Usage: subscribe <pattern>  (e.g. md.*.AAPL, md.fx.#)\n";
+                continue;
+            }
+            std::cout << "[subscribe] id=" << id << " pattern=" << pattern << '\n';
+        } else if (cmd == "unsubscribe") {
+            SubscriptionId id = 0;
+            if (!(iss >> id)) {
+                std::cerr << "Usage: unsubscribe <id>\n";
+                continue;
+            }
+            node.unsubscribe(id);
         } else if (cmd == "publish") {
             std::string topic, text;
             iss >> topic;
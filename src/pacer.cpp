@@ -0,0 +1,46 @@
+#include "pacer.h"
+
+#include <algorithm>
+#include <thread>
+
+Pacer::Pacer(double rate_per_sec, double burst)
+    : rate_(rate_per_sec)
+    , burst_(std::max(burst, 1.0))
+    , tokens_(burst_)
+    , last_(Clock::now())
+{}
+
+void Pacer::set_rate(double rate_per_sec) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill(Clock::now());
+    rate_ = rate_per_sec;
+}
+
+double Pacer::rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_;
+}
+
+Pacer::Clock::duration Pacer::reserve(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rate_ <= 0) return Clock::duration::zero();
+    refill(now);
+    tokens_ -= 1.0;
+    if (tokens_ >= 0) return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(-tokens_ / rate_));
+}
+
+void Pacer::acquire() {
+    auto wait = reserve(Clock::now());
+    if (wait > Clock::duration::zero()) std::this_thread::sleep_for(wait);
+}
+
+void Pacer::refill(Clock::time_point now) {
+    if (now <= last_) return;
+    if (rate_ > 0) {
+        double elapsed = std::chrono::duration<double>(now - last_).count();
+        tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+    }
+    last_ = now;
+}
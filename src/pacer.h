@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+// Token-bucket rate limiter for the publish path. Tokens are messages: the
+// bucket refills at rate() per second and holds at most burst() of them.
+// A rate of 0 disables pacing entirely.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Pacer(double rate_per_sec = 0, double burst = 1);
+
+    // Change the refill rate, keeping the tokens already accumulated.
+    void   set_rate(double rate_per_sec);
+    double rate() const;
+    double burst() const { return burst_; }
+
+    // Take one token at time now and return how long the caller must wait
+    // before sending (zero if a token was available). Tokens are reserved
+    // even when a wait is returned, so concurrent callers queue fairly.
+    Clock::duration reserve(Clock::time_point now);
+
+    // reserve() for the current time, then sleep for the returned wait.
+    void acquire();
+
+private:
+    void refill(Clock::time_point now);
+
+    mutable std::mutex mutex_;
+    double             rate_;
+    double             burst_;
+    double             tokens_;
+    Clock::time_point  last_;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Immutable, reference-counted byte buffer. Copying a SharedBuffer only
+// bumps a reference count, so one serialized envelope can sit in Storage,
+// in an outgoing fetch response and in a subscriber's hands at once.
+class SharedBuffer {
+public:
+    SharedBuffer() = default;
+
+    // Copy len bytes from data into a new buffer.
+    static SharedBuffer copy(const char* data, size_t len) {
+        return adopt(std::string(data, len));
+    }
+
+    // Take ownership of bytes without copying them.
+    static SharedBuffer adopt(std::string&& bytes) {
+        auto s = std::make_shared<const std::string>(std::move(bytes));
+        return SharedBuffer(s, s->data(), s->size());
+    }
+
+    // View len bytes at data that owner keeps alive (e.g. a received zmq
+    // message), without copying them.
+    static SharedBuffer wrap(std::shared_ptr<const void> owner,
+                             const char* data, size_t len) {
+        return SharedBuffer(std::move(owner), data, len);
+    }
+
+    // len bytes starting at offset, sharing this buffer's owner. The range
+    // must lie within the buffer.
+    SharedBuffer slice(size_t offset, size_t len) const {
+        return SharedBuffer(owner_, data_ + offset, len);
+    }
+
+    const char*      data()  const { return data_; }
+    size_t           size()  const { return size_; }
+    bool             empty() const { return size_ == 0; }
+    std::string_view view()  const { return {data_, size_}; }
+
+    // Number of SharedBuffers currently sharing the underlying bytes.
+    long use_count() const { return owner_.use_count(); }
+
+private:
+    SharedBuffer(std::shared_ptr<const void> owner, const char* data, size_t len)
+        : owner_(std::move(owner)), data_(data), size_(len) {}
+
+    std::shared_ptr<const void> owner_;
+    const char*                 data_{nullptr};
+    size_t                      size_{0};
+};
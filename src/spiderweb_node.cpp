@@ -3,10 +3,12 @@
 #include <iostream>
 #include <random>
 #include <sstream>
-#include <thread>
 #include <mutex>
 #include <map>
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <thread>
 
 #include "spiderweb_node.h"
 
@@ -36,21 +38,141 @@ static std::string make_uuid16() {
 }
 #endif
 
+// ---------- Wire helpers ----------
+
+// Read the key and length of a field-1, length-delimited value (tag byte
+// 0x0A, varint length) at the start of data. Returns the number of header
+// bytes, or 0 if data does not start with one. n is not bounds-checked.
+static size_t field1_header(const char* data, size_t len, uint64_t& n) {
+    const auto* p   = reinterpret_cast<const unsigned char*>(data);
+    const auto* end = p + len;
+    if (p == end || *p++ != 0x0A) return 0;
+    n = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        unsigned char b = *p++;
+        n |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return static_cast<size_t>(p - reinterpret_cast<const unsigned char*>(data));
+    }
+    return 0;
+}
+
+// Read Envelope.topic (field 1, length-delimited) straight from the wire
+// without a full parse. Serializers emit fields in number order, so topic
+// leads whenever it is set; returns false otherwise so callers can fall
+// back to ParseFromArray.
+static bool peek_topic(const char* data, size_t len, std::string_view& topic) {
+    uint64_t n;
+    size_t hdr = field1_header(data, len, n);
+    if (hdr == 0 || n > len - hdr) return false;
+    topic = std::string_view(data + hdr, n);
+    return true;
+}
+
+// Frame stored envelopes as a serialized FetchResponse without copying them:
+// `repeated Envelope envelopes = 1` is encoded as, per envelope, the tag byte
+// 0x0A and a varint length followed by the envelope's own bytes. Only those
+// small prefixes are new buffers; the envelopes are shared with Storage.
+static std::vector<SharedBuffer>
+frame_fetch_response(const std::vector<SharedBuffer>& envelopes) {
+    std::vector<SharedBuffer> frames;
+    frames.reserve(envelopes.size() * 2);
+    for (auto& e : envelopes) {
+        std::string prefix(1, '\x0A');
+        for (uint64_t n = e.size(); ; n >>= 7) {
+            if (n < 0x80) { prefix.push_back(static_cast<char>(n)); break; }
+            prefix.push_back(static_cast<char>((n & 0x7F) | 0x80));
+        }
+        frames.push_back(SharedBuffer::adopt(std::move(prefix)));
+        frames.push_back(e);
+    }
+    return frames;
+}
+
+// Inverse of frame_fetch_response: pull the envelopes out of the parts of a
+// FetchResponse reply. An envelope that arrived as a part of its own (after
+// its prefix part) is kept as that buffer; one packed inside a larger part,
+// as from an older server's single-part reply, becomes a slice of it.
+// Nothing is copied. Returns false if the parts do not form a FetchResponse.
+static bool unframe_fetch_response(const std::vector<SharedBuffer>& frames,
+                                   std::vector<SharedBuffer>& envelopes) {
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const char* p    = frames[i].data();
+        size_t      left = frames[i].size();
+        while (left > 0) {
+            uint64_t n;
+            size_t hdr = field1_header(p, left, n);
+            if (hdr == 0) return false;
+            p += hdr;
+            left -= hdr;
+            if (left == 0 && n > 0) {
+                if (i + 1 >= frames.size() || frames[i + 1].size() != n) return false;
+                envelopes.push_back(frames[++i]);
+                break;
+            }
+            if (n > left) return false;
+            envelopes.push_back(frames[i].slice(p - frames[i].data(), n));
+            p += n;
+            left -= n;
+        }
+    }
+    return true;
+}
+
 // ---------- SpiderwebNode ----------
 
+static constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(2000);
+// How long to wait on one peer before asking the next for a missing range.
+static constexpr auto FETCH_TIMEOUT      = std::chrono::milliseconds(2000);
+// Peers that have not reported our topics for longer are not counted as
+// receivers of our stream.
+static constexpr auto PEER_TIMEOUT       = 3 * HEARTBEAT_INTERVAL;
+
+// Flow control. A receiver report is congested above either threshold.
+static constexpr double LOSS_HIGH         = 0.01;
+static constexpr double FILL_HIGH         = 0.8;
+static constexpr double RATE_DECREASE     = 0.7;  // multiplicative, per heartbeat
+static constexpr double RATE_INCREASE     = 0.05; // of the ceiling, per heartbeat
+// Consecutive congested reports before a receiver that lags behind healthy
+// peers is moved to fetch-only catch-up, and how long it stays there.
+static constexpr int    SLOW_STREAK       = 5;
+static constexpr auto   FETCH_ONLY_HOLD   = std::chrono::seconds(30);
+// Largest range requested by one catch-up fetch.
+static constexpr uint64_t MAX_CATCHUP     = 4096;
+
+struct SpiderwebNode::GapFetch {
+    std::string              req_bytes;
+    std::vector<std::string> peer_addrs;
+    size_t                   next{0};
+    // Set for fetch-only catch-up: the topic, the first seq requested and
+    // the seq the publisher advertised.
+    std::string              catchup_topic;
+    uint64_t                 catchup_from{0};
+    uint64_t                 catchup_to{0};
+};
+
 SpiderwebNode::SpiderwebNode(const std::string& node_id,
                              const std::string& zmq_bind_addr,
                              const std::string& payload_mcast_addr,
                              int                payload_mcast_port,
                              const std::string& ctrl_mcast_addr,
-                             int                ctrl_mcast_port)
+                             int                ctrl_mcast_port,
+                             EventLoopOptions   loop_opts,
+                             FlowControlOptions flow_opts)
     : node_id_(node_id)
     , zmq_bind_addr_(zmq_bind_addr)
     , payload_mcast_addr_(payload_mcast_addr)
     , payload_mcast_port_(payload_mcast_port)
     , ctrl_mcast_addr_(ctrl_mcast_addr)
     , ctrl_mcast_port_(ctrl_mcast_port)
-{}
+    , loop_(loop_opts)
+    , flow_opts_(flow_opts)
+    , pacer_(flow_opts.rate, flow_opts.burst)
+{
+    // A floor above the ceiling would make backing off raise the rate.
+    if (flow_opts_.rate > 0)
+        flow_opts_.min_rate = std::min(flow_opts_.min_rate, flow_opts_.rate);
+}
 
 SpiderwebNode::~SpiderwebNode() {
     stop();
@@ -65,51 +187,87 @@ void SpiderwebNode::start() {
     ctrl_transport_.init_sender(ctrl_mcast_addr_, ctrl_mcast_port_);
     ctrl_transport_.init_receiver(ctrl_mcast_addr_, ctrl_mcast_port_);
 
-    // Start ZMQ fetch server.
-    zmq_fetch_.start_server(zmq_bind_addr_,
-        [this](const std::string& req_bytes) -> std::string {
+    const EventLoopOptions& opts = loop_.options();
+    if (opts.busy_poll && opts.socket_busy_poll_usec > 0) {
+        if (!payload_transport_.set_busy_poll(opts.socket_busy_poll_usec) ||
+            !ctrl_transport_.set_busy_poll(opts.socket_busy_poll_usec)) {
+            std::cerr << "[spiderweb] SO_BUSY_POLL not available; "
+                         "continuing with loop-level busy polling only\n";
+        }
+    }
+
+    // Start ZMQ fetch server on the event loop.
+    zmq_fetch_.start_server(loop_, zmq_bind_addr_,
+        [this](const std::string& req_bytes) -> std::vector<SharedBuffer> {
             transport::FetchRequest req;
             if (!req.ParseFromString(req_bytes)) return {};
-            auto envelopes = storage_.fetch(req.topic(), req.from(), req.to());
-            transport::FetchResponse resp;
-            for (auto& e : envelopes) {
-                transport::Envelope env;
-                if (env.ParseFromString(e))
-                    resp.add_envelopes()->CopyFrom(env);
-            }
-            std::string out;
-            resp.SerializeToString(&out);
-            return out;
+            auto frames = frame_fetch_response(
+                storage_.fetch(req.topic(), req.from(), req.to()));
+            if (req.multipart()) return frames;
+            // Older clients read only the first part of a reply.
+            std::string joined;
+            for (auto& f : frames) joined.append(f.view());
+            return {SharedBuffer::adopt(std::move(joined))};
         });
 
-    running_ = true;
-
-    payload_transport_.start_recv(
-        [this](const char* d, size_t n){ on_payload_recv(d, n); });
-    ctrl_transport_.start_recv(
-        [this](const char* d, size_t n){ on_ctrl_recv(d, n); });
-
-    heartbeat_thread_ = std::thread([this]{ heartbeat_loop(); });
+    loop_.add_fd(payload_transport_.recv_fd(), [this]{
+        // Sample occupancy before draining: that is the pressure we saw.
+        rx_fill_peak_ = std::max(rx_fill_peak_, payload_transport_.rx_buffer_fill());
+        payload_transport_.drain(
+            [this](const char* d, size_t n){ on_payload_recv(d, n); });
+    });
+    loop_.add_fd(ctrl_transport_.recv_fd(), [this]{
+        ctrl_transport_.drain(
+            [this](const char* d, size_t n){ on_ctrl_recv(d, n); });
+    });
+
+    loop_.post([this]{ send_heartbeat(); });
+    loop_.add_periodic_timer(HEARTBEAT_INTERVAL, [this]{ send_heartbeat(); });
+
+    loop_.start_thread();
 }
 
 void SpiderwebNode::stop() {
-    running_ = false;
-    payload_transport_.stop_recv();
-    ctrl_transport_.stop_recv();
+    loop_.stop();
+    loop_.remove_fd(payload_transport_.recv_fd());
+    loop_.remove_fd(ctrl_transport_.recv_fd());
     zmq_fetch_.stop_server();
-    if (heartbeat_thread_.joinable()) heartbeat_thread_.join();
 }
 
 void SpiderwebNode::publish(const std::string& topic,
                             const std::string& payload_bytes) {
-    transport::Envelope env;
-    env.set_topic(topic);
+    // Take the token first: a seq is only assigned once the message may go.
+    auto now  = Pacer::Clock::now();
+    auto wait = pacer_.reserve(now);
+    if (loop_.in_loop_thread()) {
+        // Sleeping here would stall draining, heartbeats and fetches; queue
+        // behind any earlier deferred send instead.
+        if (wait > Pacer::Clock::duration::zero() || !deferred_.empty()) {
+            deferred_.push_back({now + wait, topic, payload_bytes});
+            if (deferred_.size() == 1) flush_deferred();
+            return;
+        }
+    } else if (wait > Pacer::Clock::duration::zero()) {
+        std::this_thread::sleep_for(wait);
+    }
+    send_envelope(topic, payload_bytes);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(seq_mutex_);
-        env.set_seq(++out_seq_[topic]);
+void SpiderwebNode::flush_deferred() {
+    auto now = Pacer::Clock::now();
+    while (!deferred_.empty() && deferred_.front().due <= now) {
+        send_envelope(deferred_.front().topic, deferred_.front().payload_bytes);
+        deferred_.pop_front();
     }
+    if (deferred_.empty()) return;
+    auto delay = std::chrono::ceil<std::chrono::milliseconds>(deferred_.front().due - now);
+    loop_.add_timer(delay, [this]{ flush_deferred(); });
+}
 
+void SpiderwebNode::send_envelope(const std::string& topic,
+                                  const std::string& payload_bytes) {
+    transport::Envelope env;
+    env.set_topic(topic);
     env.set_uuid(gen_uuid16());
 
     *env.mutable_ts() =
@@ -121,60 +279,146 @@ void SpiderwebNode::publish(const std::string& topic,
     any.set_value(payload_bytes);
     *env.mutable_payload() = std::move(any);
 
-    std::string serialized;
-    env.SerializeToString(&serialized);
+    std::lock_guard<std::mutex> publish_lock(publish_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(seq_mutex_);
+        env.set_seq(++out_seq_[topic]);
+    }
+
+    std::string bytes;
+    env.SerializeToString(&bytes);
+    SharedBuffer serialized = SharedBuffer::adopt(std::move(bytes));
 
     payload_transport_.send(serialized.data(), serialized.size());
     storage_.append(topic, env.seq(), serialized);
 }
 
+SubscriptionId SpiderwebNode::subscribe(const std::string& pattern,
+                                        SubscriptionHandler handler) {
+    SubscriptionId id = topic_matcher_.add(pattern);
+    if (id == 0) return 0;
+    std::lock_guard<std::mutex> lock(subs_mutex_);
+    handlers_[id] = std::move(handler);
+    return id;
+}
+
+void SpiderwebNode::unsubscribe(SubscriptionId id) {
+    topic_matcher_.remove(id);
+    std::lock_guard<std::mutex> lock(subs_mutex_);
+    handlers_.erase(id);
+}
+
+void SpiderwebNode::deliver(const transport::Envelope& env,
+                            const SharedBuffer& raw,
+                            const TopicMatcher::Matches& matches) {
+    if (!matches || matches->empty()) return;
+    std::vector<SubscriptionHandler> targets;
+    {
+        std::lock_guard<std::mutex> lock(subs_mutex_);
+        for (SubscriptionId id : *matches) {
+            auto it = handlers_.find(id);
+            if (it != handlers_.end() && it->second) targets.push_back(it->second);
+        }
+    }
+    for (auto& h : targets) h(env, raw);
+}
+
 void SpiderwebNode::on_payload_recv(const char* data, size_t len) {
+    // Once anything is subscribed, drop unwanted topics straight off the
+    // wire, before the parse, dedup and storage work below.
+    const bool filtering = !topic_matcher_.empty();
+    TopicMatcher::Matches matches;
+    std::string_view wire_topic;
+    if (filtering && peek_topic(data, len, wire_topic)) {
+        matches = topic_matcher_.match(wire_topic);
+        if (matches->empty()) return;
+    }
+
     transport::Envelope env;
     if (!env.ParseFromArray(data, static_cast<int>(len))) return;
 
+    if (filtering && !matches) {
+        matches = topic_matcher_.match(env.topic());
+        if (matches->empty()) return;
+    }
+
     if (dedup_.is_duplicate_and_mark(env.uuid())) return;
 
     // Capture the last known seq BEFORE appending so we can detect gaps.
     uint64_t prev_last = storage_.last_seq(env.topic());
-    storage_.append(env.topic(), env.seq(), std::string(data, len));
+    // The one copy out of the receive buffer; storage, fetch responses and
+    // subscribers all share it from here on.
+    SharedBuffer raw = SharedBuffer::copy(data, len);
+    storage_.append(env.topic(), env.seq(), raw);
+    deliver(env, raw, matches);
+
+    RxStats& rx = rx_by_topic_[env.topic()];
+    ++rx.received;
 
     // Gap detection: check if any sequences were skipped.
     if (env.seq() > prev_last + 1) {
         uint64_t from = prev_last + 1;
         uint64_t to   = env.seq() - 1;
+        // A first message on a topic is a late join, not loss.
+        if (prev_last > 0) rx.missed += to - from + 1;
 
         // Build FetchRequest.
         transport::FetchRequest req;
         req.set_topic(env.topic());
         req.set_from(from);
         req.set_to(to);
+        req.set_multipart(true);
         std::string req_bytes;
         req.SerializeToString(&req_bytes);
 
-        // Try each known peer.
-        std::map<std::string, PeerInfo> snapshot;
+        // Ask each peer that has seen the range, one at a time.
+        auto gap = std::make_shared<GapFetch>();
+        gap->req_bytes = std::move(req_bytes);
         {
             std::lock_guard<std::mutex> lock(peers_mutex_);
-            snapshot = peer_map_;
+            for (auto& [peer_id, info] : peer_map_) {
+                auto it = info.last_seq.find(env.topic());
+                if (it == info.last_seq.end() || it->second < to) continue;
+                gap->peer_addrs.push_back(info.zmq_addr);
+            }
         }
-        for (auto& [peer_id, info] : snapshot) {
-            auto it = info.last_seq.find(env.topic());
-            if (it == info.last_seq.end() || it->second < to) continue;
-
-            std::string resp_bytes = zmq_fetch_.fetch_from(info.zmq_addr, req_bytes);
-            if (resp_bytes.empty()) continue;
+        fetch_gap(std::move(gap));
+    }
+}
 
-            transport::FetchResponse resp;
-            if (!resp.ParseFromString(resp_bytes)) continue;
-            for (auto& fetched : resp.envelopes()) {
+void SpiderwebNode::fetch_gap(std::shared_ptr<GapFetch> gap) {
+    if (gap->next >= gap->peer_addrs.size()) { finish_gap(*gap); return; }
+    const std::string& addr = gap->peer_addrs[gap->next++];
+    zmq_fetch_.fetch_async(loop_, addr, gap->req_bytes, FETCH_TIMEOUT,
+        [this, gap](const std::vector<SharedBuffer>& frames) {
+            std::vector<SharedBuffer> envelopes;
+            if (!unframe_fetch_response(frames, envelopes) || envelopes.empty()) {
+                fetch_gap(gap); // timed out or failed; try the next peer
+                return;
+            }
+            // Store the received bytes as they are; the parse only reads
+            // the fields needed for dedup, storage and delivery.
+            for (auto& raw : envelopes) {
+                transport::Envelope fetched;
+                if (!fetched.ParseFromArray(raw.data(), static_cast<int>(raw.size())))
+                    continue;
                 if (dedup_.is_duplicate_and_mark(fetched.uuid())) continue;
-                std::string s;
-                fetched.SerializeToString(&s);
-                storage_.append(fetched.topic(), fetched.seq(), s);
+                storage_.append(fetched.topic(), fetched.seq(), raw);
+                deliver(fetched, raw, topic_matcher_.match(fetched.topic()));
             }
-            break;
-        }
-    }
+            finish_gap(*gap);
+        });
+}
+
+void SpiderwebNode::finish_gap(const GapFetch& gap) {
+    if (gap.catchup_topic.empty()) return;
+    catchup_inflight_.erase(gap.catchup_topic);
+
+    // Chain the next range straight away rather than waiting for the next
+    // heartbeat, as long as the last fetch made progress.
+    uint64_t mine = storage_.last_seq(gap.catchup_topic);
+    if (!fetch_only_by_.empty() && mine >= gap.catchup_from && mine < gap.catchup_to)
+        start_catch_up(gap.catchup_topic, gap.peer_addrs.front(), gap.catchup_to);
 }
 
 void SpiderwebNode::on_ctrl_recv(const char* data, size_t len) {
@@ -182,36 +426,179 @@ void SpiderwebNode::on_ctrl_recv(const char* data, size_t len) {
     if (!hb.ParseFromArray(data, static_cast<int>(len))) return;
     if (hb.node_id() == node_id_) return; // ignore our own heartbeats
 
-    std::lock_guard<std::mutex> lock(peers_mutex_);
-    auto& info    = peer_map_[hb.node_id()];
-    info.zmq_addr = hb.zmq_addr();
+    auto now = std::chrono::steady_clock::now();
+    const bool track_congestion = paced_publisher();
+
+    // Only loss on topics we publish counts against our rate: a peer that
+    // filters them out, or only loses another publisher's stream, is not
+    // held back by us.
+    bool   receives_ours = false;
+    double our_loss      = 0;
+    if (track_congestion) {
+        std::lock_guard<std::mutex> lock(seq_mutex_);
+        for (auto& [topic, loss] : hb.topic_loss()) {
+            if (!out_seq_.count(topic)) continue;
+            receives_ours = true;
+            our_loss = std::max(our_loss, loss);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        auto& info    = peer_map_[hb.node_id()];
+        info.zmq_addr = hb.zmq_addr();
+        for (auto& [topic, seq] : hb.last_seq()) {
+            info.last_seq[topic] = seq;
+        }
+        info.rx_buffer_fill = hb.rx_buffer_fill();
+        info.loss_rate      = our_loss;
+        if (receives_ours) info.heard_ours = now;
+        if (track_congestion) {
+            // The receive buffer is shared by every stream on the payload
+            // group, so its fill counts for any peer receiving ours.
+            bool congested = now - info.heard_ours <= PEER_TIMEOUT &&
+                (our_loss > LOSS_HIGH || hb.rx_buffer_fill() > FILL_HIGH);
+            info.congested_streak = congested ? info.congested_streak + 1 : 0;
+        }
+    }
+
+    // Has this peer parked us on fetch-only catch-up?
+    const auto& parked = hb.fetch_only();
+    if (std::find(parked.begin(), parked.end(), node_id_) != parked.end())
+        fetch_only_by_[hb.node_id()] = now;
+    else
+        fetch_only_by_.erase(hb.node_id());
+
+    // Stop reading multicast payloads while any peer asks us to, so the
+    // socket buffer stops overflowing; catch up from heartbeats instead.
+    payload_transport_.set_membership(fetch_only_by_.empty());
+    if (!fetch_only_by_.empty()) catch_up_from(hb);
+}
+
+void SpiderwebNode::catch_up_from(const transport::Heartbeat& hb) {
+    const bool filtering = !topic_matcher_.empty();
     for (auto& [topic, seq] : hb.last_seq()) {
-        info.last_seq[topic] = seq;
+        if (filtering && topic_matcher_.match(topic)->empty()) continue;
+        if (catchup_inflight_.count(topic)) continue;
+        start_catch_up(topic, hb.zmq_addr(), seq);
     }
 }
 
-void SpiderwebNode::heartbeat_loop() {
-    while (running_) {
-        transport::Heartbeat hb;
-        hb.set_node_id(node_id_);
-        hb.set_zmq_addr(zmq_bind_addr_);
+void SpiderwebNode::start_catch_up(const std::string& topic,
+                                   const std::string& peer_addr,
+                                   uint64_t target) {
+    uint64_t mine = storage_.last_seq(topic);
+    if (target <= mine) return;
+
+    transport::FetchRequest req;
+    req.set_topic(topic);
+    req.set_from(mine + 1);
+    req.set_to(std::min(target, mine + MAX_CATCHUP));
+    req.set_multipart(true);
+
+    auto gap = std::make_shared<GapFetch>();
+    req.SerializeToString(&gap->req_bytes);
+    gap->peer_addrs.push_back(peer_addr);
+    gap->catchup_topic = topic;
+    gap->catchup_from  = mine + 1;
+    gap->catchup_to    = target;
+    catchup_inflight_.insert(topic);
+    fetch_gap(std::move(gap));
+}
 
-        // Snapshot last_seq per topic from storage.
-        // (We iterate out_seq_ as a proxy for topics we've published.)
-        {
-            std::lock_guard<std::mutex> lock(seq_mutex_);
-            for (auto& [topic, _] : out_seq_) {
-                (*hb.mutable_last_seq())[topic] = storage_.last_seq(topic);
+bool SpiderwebNode::paced_publisher() const {
+    if (flow_opts_.rate <= 0) return false;
+    std::lock_guard<std::mutex> lock(seq_mutex_);
+    return !out_seq_.empty();
+}
+
+void SpiderwebNode::adapt_rate() {
+    if (!paced_publisher()) return;
+    auto now = std::chrono::steady_clock::now();
+    bool any_congested = false;
+    {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+
+        // Release parked receivers after the hold so they can prove they
+        // keep up again; collect whether the healthy rest is keeping up.
+        bool any_keeping_up = false;
+        for (auto& [id, p] : peer_map_) {
+            if (p.fetch_only && now - p.fetch_only_since >= FETCH_ONLY_HOLD) {
+                p.fetch_only       = false;
+                p.congested_streak = 0;
+            }
+            if (p.fetch_only || now - p.heard_ours > PEER_TIMEOUT) continue;
+            if (p.congested_streak == 0) any_keeping_up = true;
+        }
+
+        // A receiver congested for several heartbeats while others keep up
+        // is the bottleneck, not the network: park it rather than slow
+        // every subscriber down to its pace.
+        for (auto& [id, p] : peer_map_) {
+            if (p.fetch_only || now - p.heard_ours > PEER_TIMEOUT) continue;
+            if (p.congested_streak >= SLOW_STREAK && any_keeping_up) {
+                p.fetch_only       = true;
+                p.fetch_only_since = now;
+                continue;
             }
+            if (p.congested_streak > 0) any_congested = true;
         }
+    }
 
-        std::string serialized;
-        hb.SerializeToString(&serialized);
-        Heartbeat::send_heartbeat(ctrl_mcast_addr_, ctrl_mcast_port_, serialized);
+    if (!flow_opts_.adaptive) return;
+    double rate = pacer_.rate();
+    if (any_congested)
+        rate = std::max(flow_opts_.min_rate, rate * RATE_DECREASE);
+    else
+        rate = std::min(flow_opts_.rate, rate + flow_opts_.rate * RATE_INCREASE);
+    pacer_.set_rate(rate);
+}
 
-        for (int i = 0; i < 20 && running_; ++i)
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+void SpiderwebNode::send_heartbeat() {
+    adapt_rate();
+
+    transport::Heartbeat hb;
+    hb.set_node_id(node_id_);
+    hb.set_zmq_addr(zmq_bind_addr_);
+
+    // Report receive health since the last heartbeat, then start afresh.
+    uint64_t received = 0, missed = 0;
+    for (auto& [topic, rx] : rx_by_topic_) {
+        (*hb.mutable_topic_loss())[topic] =
+            static_cast<double>(rx.missed) / (rx.received + rx.missed);
+        received += rx.received;
+        missed   += rx.missed;
+    }
+    hb.set_loss_rate(received + missed ? static_cast<double>(missed) / (received + missed) : 0.0);
+    hb.set_rx_buffer_fill(rx_fill_peak_);
+    rx_by_topic_.clear();
+    rx_fill_peak_ = 0;
+
+    // Forget fetch-only requests from peers that have gone quiet.
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = fetch_only_by_.begin(); it != fetch_only_by_.end();) {
+        if (now - it->second > PEER_TIMEOUT) it = fetch_only_by_.erase(it);
+        else ++it;
+    }
+    payload_transport_.set_membership(fetch_only_by_.empty());
+
+    if (paced_publisher()) {
+        std::lock_guard<std::mutex> lock(peers_mutex_);
+        for (auto& [id, p] : peer_map_)
+            if (p.fetch_only) hb.add_fetch_only(id);
+    }
+
+    // Snapshot last_seq per topic from storage.
+    // (We iterate out_seq_ as a proxy for topics we've published.)
+    {
+        std::lock_guard<std::mutex> lock(seq_mutex_);
+        for (auto& [topic, _] : out_seq_) {
+            (*hb.mutable_last_seq())[topic] = storage_.last_seq(topic);
+        }
     }
+
+    std::string serialized;
+    hb.SerializeToString(&serialized);
+    Heartbeat::send_heartbeat(ctrl_mcast_addr_, ctrl_mcast_port_, serialized);
 }
 
 std::string SpiderwebNode::gen_uuid16() {
@@ -1,19 +1,44 @@
 #pragma once
 
 #include <string>
+#include <chrono>
+#include <deque>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <thread>
-#include <atomic>
+#include <set>
 #include <functional>
 
+#include "event_loop.h"
 #include "udp_transport.h"
 #include "storage.h"
 #include "deduplicator.h"
 #include "zmq_fetch.h"
+#include "topic_matcher.h"
+#include "pacer.h"
 
 // Forward-declared to avoid pulling in generated headers here.
 namespace google { namespace protobuf { class Message; } }
+namespace transport { class Envelope; class Heartbeat; }
+
+// Invoked on the event-loop thread for every new envelope whose topic
+// matches the subscription's pattern. raw holds the envelope's serialized
+// bytes, shared with Storage; keep a copy of it to retain the message
+// without copying the bytes.
+using SubscriptionHandler =
+    std::function<void(const transport::Envelope& env, const SharedBuffer& raw)>;
+
+struct FlowControlOptions {
+    // Publish rate ceiling in messages/s; 0 leaves publishing unpaced.
+    double rate{0};
+    // Messages that may go out back-to-back before pacing applies.
+    double burst{64};
+    // Floor for the adaptive rate; clamped to rate.
+    double min_rate{100};
+    // Lower the rate when healthy receivers report loss or buffer pressure
+    // in their heartbeats, and raise it back towards rate when they recover.
+    bool   adaptive{true};
+};
 
 class SpiderwebNode {
 public:
@@ -22,28 +47,61 @@ public:
                   const std::string& payload_mcast_addr,
                   int                payload_mcast_port,
                   const std::string& ctrl_mcast_addr,
-                  int                ctrl_mcast_port);
+                  int                ctrl_mcast_port,
+                  EventLoopOptions   loop_opts = {},
+                  FlowControlOptions flow_opts = {});
     ~SpiderwebNode();
 
     void start();
     void stop();
 
-    // Publish raw serialized bytes under topic.
+    // Publish raw serialized bytes under topic. Blocks as needed to keep
+    // to the current paced rate; called from a subscription handler (the
+    // event-loop thread) it never blocks, and a send that must wait is
+    // queued on the loop instead, keeping publish order.
     void publish(const std::string& topic, const std::string& payload_bytes);
 
     // Publish a protobuf message under topic; wraps it in google.protobuf.Any.
     template <typename T>
     void publishProto(const std::string& topic, const T& msg);
 
+    // Subscribe to a topic pattern ("md.eq.AAPL", "md.*.AAPL", "md.fx.#").
+    // Until the first subscription a node keeps every topic it receives;
+    // afterwards envelopes matching no pattern are dropped on arrival,
+    // before dedup and storage. Returns 0 if the pattern is malformed.
+    SubscriptionId subscribe(const std::string& pattern,
+                             SubscriptionHandler handler = {});
+
+    // Remove a subscription returned by subscribe().
+    void unsubscribe(SubscriptionId id);
+
     // Return a snapshot of known peers: node_id -> zmq_addr.
     std::map<std::string, std::string> peers() const;
 
 private:
+    // Assign the next seq for topic and send; the pacing token is already
+    // taken.
+    void send_envelope(const std::string& topic, const std::string& payload_bytes);
+    void flush_deferred();
     void on_payload_recv(const char* data, size_t len);
     void on_ctrl_recv(const char* data, size_t len);
-    void heartbeat_loop();
+    void send_heartbeat();
+    void adapt_rate();
+    // True once this node has published with pacing enabled; only then does
+    // it track receiver congestion and park slow receivers.
+    bool paced_publisher() const;
+    void catch_up_from(const transport::Heartbeat& hb);
+    void start_catch_up(const std::string& topic, const std::string& peer_addr,
+                        uint64_t target);
+    void deliver(const transport::Envelope& env, const SharedBuffer& raw,
+                 const TopicMatcher::Matches& matches);
     std::string gen_uuid16();
 
+    // Remaining peers to ask for one missing range.
+    struct GapFetch;
+    void fetch_gap(std::shared_ptr<GapFetch> gap);
+    void finish_gap(const GapFetch& gap);
+
     std::string node_id_;
     std::string zmq_bind_addr_;
     std::string payload_mcast_addr_;
@@ -51,24 +109,66 @@ private:
     std::string ctrl_mcast_addr_;
     int         ctrl_mcast_port_;
 
+    // Declared before the components it drives so it is destroyed last.
+    EventLoop      loop_;
     UDPTransport   payload_transport_;
     UDPTransport   ctrl_transport_;
     Storage        storage_;
     Deduplicator   dedup_;
     ZMQFetch       zmq_fetch_;
+    TopicMatcher   topic_matcher_;
+    FlowControlOptions flow_opts_;
+    Pacer              pacer_;
+
+    // Receive-side health for our next heartbeat (loop thread only).
+    struct RxStats {
+        uint64_t received{0};
+        uint64_t missed{0};
+    };
+    std::map<std::string, RxStats> rx_by_topic_;
+    double rx_fill_peak_{0};
 
-    std::atomic<bool> running_{false};
-    std::thread       heartbeat_thread_;
+    // Peers whose heartbeats currently put us in fetch-only mode, and topics
+    // with a catch-up fetch in flight (loop thread only).
+    std::map<std::string, std::chrono::steady_clock::time_point> fetch_only_by_;
+    std::set<std::string> catchup_inflight_;
+
+    mutable std::mutex subs_mutex_;
+    std::map<SubscriptionId, SubscriptionHandler> handlers_;
+
+
+    // Held from seq assignment through the send, so seqs leave in order.
+    std::mutex publish_mutex_;
 
     // Sequence counter for outgoing messages per topic.
     mutable std::mutex seq_mutex_;
     std::map<std::string, uint64_t> out_seq_;
 
+    // Paced publishes made on the loop thread, waiting for their token
+    // (loop thread only).
+    struct DeferredPublish {
+        Pacer::Clock::time_point due;
+        std::string              topic;
+        std::string              payload_bytes;
+    };
+    std::deque<DeferredPublish> deferred_;
+
     // Peer map: node_id -> {zmq_addr, last_seq per topic}
     mutable std::mutex peers_mutex_;
     struct PeerInfo {
         std::string zmq_addr;
         std::map<std::string, uint64_t> last_seq;
+        // Latest receiver report and how many in a row showed congestion.
+        // loss_rate only covers the topics we publish.
+        double rx_buffer_fill{0};
+        double loss_rate{0};
+        int    congested_streak{0};
+        // Last heartbeat reporting receipt of one of our topics; peers that
+        // have not sent one recently are not receivers of our stream.
+        std::chrono::steady_clock::time_point heard_ours;
+        // Set while we ask this peer to catch up via fetch only.
+        bool   fetch_only{false};
+        std::chrono::steady_clock::time_point fetch_only_since;
     };
     std::map<std::string, PeerInfo> peer_map_;
 };
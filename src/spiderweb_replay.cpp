@@ -0,0 +1,278 @@
+// spiderweb_replay: record the payload and control multicast streams to a
+// capture file, or send a capture back out for repeatable load tests.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_file.h"
+#include "event_loop.h"
+#include "udp_transport.h"
+#include "transport.pb.h"
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<bool> g_interrupted{false};
+
+static void on_signal(int) { g_interrupted = true; }
+
+static void usage(const char* prog) {
+    std::cerr << "Usage:\n"
+              << "  " << prog << " capture <file> <payload_mcast_addr> <payload_mcast_port>"
+                 " <ctrl_mcast_addr> <ctrl_mcast_port> [--duration=<s>] [--busy-poll] [--cpu=<n>]\n"
+              << "  " << prog << " replay  <file> <payload_mcast_addr> <payload_mcast_port>"
+                 " <ctrl_mcast_addr> <ctrl_mcast_port> [--speed=<x>|max] [--loss=<p>]"
+                 " [--reorder=<p>] [--seed=<n>]\n"
+              << "\nReplay options:\n"
+              << "  --speed=<x>   1 = original timing (default), 2 = twice as fast,"
+                 " max = no waiting\n"
+              << "  --loss=<p>    drop each datagram with probability p\n"
+              << "  --reorder=<p> swap each datagram with the next with probability p\n"
+              << "  --seed=<n>    RNG seed for loss/reorder (default 1), so runs repeat\n"
+              << "\nExample:\n"
+              << "  " << prog << " capture md.cap 239.0.0.1 5000 239.0.0.2 5001 --duration=60\n"
+              << "  " << prog << " replay  md.cap 239.0.0.1 5000 239.0.0.2 5001 --speed=max --loss=0.01\n";
+}
+
+// Summarise a set of records through the transport protos: datagrams per
+// channel, topics and sequence holes on the payload stream, heartbeating nodes.
+static void print_summary(const std::vector<CaptureRecord>& records) {
+    size_t payload = 0, control = 0, unparsed = 0;
+    std::map<std::string, std::set<uint64_t>> seqs;
+    std::set<std::string> nodes;
+    for (auto& r : records) {
+        if (r.channel == CaptureChannel::Payload) {
+            ++payload;
+            transport::Envelope env;
+            if (env.ParseFromString(r.bytes)) seqs[env.topic()].insert(env.seq());
+            else ++unparsed;
+        } else {
+            ++control;
+            transport::Heartbeat hb;
+            if (hb.ParseFromString(r.bytes)) nodes.insert(hb.node_id());
+            else ++unparsed;
+        }
+    }
+    uint64_t span_ms = records.empty() ? 0 : records.back().t_ns / 1000000;
+    std::cout << "records=" << records.size() << " payload=" << payload
+              << " control=" << control << " unparsed=" << unparsed
+              << " span_ms=" << span_ms << " nodes=" << nodes.size() << '\n';
+    for (auto& [topic, s] : seqs) {
+        uint64_t holes = *s.rbegin() - *s.begin() + 1 - s.size();
+        std::cout << "  topic=" << topic << " msgs=" << s.size()
+                  << " seq=[" << *s.begin() << ", " << *s.rbegin() << "]"
+                  << " holes=" << holes << '\n';
+    }
+}
+
+static bool init_pair(UDPTransport& payload, UDPTransport& ctrl, bool receiver,
+                      char* argv[]) {
+    const std::string payload_addr = argv[3];
+    const int         payload_port = std::stoi(argv[4]);
+    const std::string ctrl_addr    = argv[5];
+    const int         ctrl_port    = std::stoi(argv[6]);
+    if (receiver)
+        return payload.init_receiver(payload_addr, payload_port) &&
+               ctrl.init_receiver(ctrl_addr, ctrl_port);
+    return payload.init_sender(payload_addr, payload_port) &&
+           ctrl.init_sender(ctrl_addr, ctrl_port);
+}
+
+static int run_capture(int argc, char* argv[]) {
+    const std::string path = argv[2];
+    EventLoopOptions loop_opts;
+    double duration_s = 0;
+    for (int i = 7; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--busy-poll") {
+            loop_opts.busy_poll = true;
+        } else if (arg.rfind("--cpu=", 0) == 0) {
+            loop_opts.cpu = std::stoi(arg.substr(6));
+        } else if (arg.rfind("--duration=", 0) == 0) {
+            duration_s = std::stod(arg.substr(11));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    UDPTransport payload, ctrl;
+    if (!init_pair(payload, ctrl, true, argv)) {
+        std::cerr << "[replay] failed to join multicast groups\n";
+        return 1;
+    }
+    if (loop_opts.busy_poll) {
+        payload.set_busy_poll(loop_opts.socket_busy_poll_usec);
+        ctrl.set_busy_poll(loop_opts.socket_busy_poll_usec);
+    }
+    if (!payload.enable_rx_timestamps() || !ctrl.enable_rx_timestamps())
+        std::cerr << "[replay] kernel rx timestamps unavailable; using drain time\n";
+
+    CaptureWriter writer;
+    auto wall_now = []{
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    const uint64_t wall_ns = wall_now();
+    if (!writer.open(path, wall_ns)) {
+        std::cerr << "[replay] cannot write " << path << '\n';
+        return 1;
+    }
+
+    const auto t0 = Clock::now();
+    EventLoop loop(loop_opts);
+    bool write_failed = false;
+    // Records carry the kernel's arrival time (SO_TIMESTAMPNS), or the drain
+    // time when a datagram has none. Both are wall-clock, relative to the
+    // header's start time; datagrams queued before the start count as 0.
+    auto record = [&](CaptureChannel ch, const char* d, size_t n, uint64_t rx_ns) {
+        if (write_failed) return;
+        if (rx_ns == 0) rx_ns = wall_now();
+        uint64_t t = rx_ns > wall_ns ? rx_ns - wall_ns : 0;
+        if (!writer.write(t, ch, d, n)) {
+            write_failed = true;
+            loop.stop();
+        }
+    };
+    UdpTimedRecvCallback on_payload = [&](const char* d, size_t n, uint64_t rx_ns) {
+        record(CaptureChannel::Payload, d, n, rx_ns);
+    };
+    UdpTimedRecvCallback on_ctrl = [&](const char* d, size_t n, uint64_t rx_ns) {
+        record(CaptureChannel::Control, d, n, rx_ns);
+    };
+
+    loop.add_fd(payload.recv_fd(), [&]{ payload.drain_timestamped(on_payload); });
+    loop.add_fd(ctrl.recv_fd(),    [&]{ ctrl.drain_timestamped(on_ctrl); });
+    loop.add_periodic_timer(std::chrono::milliseconds(100), [&]{
+        bool expired = duration_s > 0 &&
+            Clock::now() - t0 >= std::chrono::duration<double>(duration_s);
+        if (g_interrupted || expired) loop.stop();
+    });
+
+    std::cout << "[capture] recording to " << path << " (Ctrl-C to stop)\n";
+    loop.run();
+
+    if (!writer.close() || write_failed) {
+        std::cerr << "[replay] write error on " << path << '\n';
+        return 1;
+    }
+    std::vector<CaptureRecord> records;
+    if (load_capture(path, records)) print_summary(records);
+    return 0;
+}
+
+static int run_replay(int argc, char* argv[]) {
+    const std::string path = argv[2];
+    double   speed   = 1.0; // 0 = as fast as possible
+    double   loss    = 0.0;
+    double   reorder = 0.0;
+    uint64_t seed    = 1;
+    for (int i = 7; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--speed=max") {
+            speed = 0;
+        } else if (arg.rfind("--speed=", 0) == 0) {
+            speed = std::stod(arg.substr(8));
+            if (speed <= 0) { usage(argv[0]); return 1; }
+        } else if (arg.rfind("--loss=", 0) == 0) {
+            loss = std::stod(arg.substr(7));
+        } else if (arg.rfind("--reorder=", 0) == 0) {
+            reorder = std::stod(arg.substr(10));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            seed = std::stoull(arg.substr(7));
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<CaptureRecord> records;
+    if (!load_capture(path, records)) {
+        std::cerr << "[replay] cannot read capture " << path << '\n';
+        return 1;
+    }
+
+    UDPTransport payload, ctrl;
+    if (!init_pair(payload, ctrl, false, argv)) {
+        std::cerr << "[replay] failed to open multicast senders\n";
+        return 1;
+    }
+
+    // Decide drops and swaps up front so a given seed always produces the
+    // same send order, independent of timing.
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<size_t> order;
+    order.reserve(records.size());
+    size_t dropped = 0, swapped = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (loss > 0 && coin(rng) < loss) { ++dropped; continue; }
+        order.push_back(i);
+    }
+    for (size_t i = 0; i + 1 < order.size(); ++i) {
+        if (reorder > 0 && coin(rng) < reorder) {
+            std::swap(order[i], order[i + 1]);
+            ++swapped;
+            ++i; // a datagram moves at most one slot
+        }
+    }
+
+    std::cout << "[replay] " << path << ": ";
+    print_summary(records);
+    std::cout << "[replay] dropping " << dropped << ", swapping " << swapped
+              << " pair(s), seed " << seed << '\n';
+
+    // Send on the original (scaled) schedule: each slot keeps the timestamp
+    // of its position in the capture, so reordered datagrams trade times.
+    std::vector<uint64_t> slot_ns;
+    slot_ns.reserve(order.size());
+    for (size_t idx : order) slot_ns.push_back(records[idx].t_ns);
+    std::sort(slot_ns.begin(), slot_ns.end());
+    // Start sending at once rather than replaying the idle lead-in.
+    const uint64_t first_ns = slot_ns.empty() ? 0 : slot_ns.front();
+
+    const auto t0 = Clock::now();
+    size_t sent = 0, failed = 0;
+    for (size_t k = 0; k < order.size() && !g_interrupted; ++k) {
+        const CaptureRecord& r = records[order[k]];
+        if (speed > 0) {
+            auto due = t0 + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::nanoseconds(slot_ns[k] - first_ns) / speed);
+            // Sleep for the bulk of the wait, then spin the last stretch:
+            // sleep_until alone overshoots by the scheduler's granularity.
+            auto spin_from = due - std::chrono::microseconds(200);
+            if (Clock::now() < spin_from) std::this_thread::sleep_until(spin_from);
+            while (Clock::now() < due) {}
+        }
+        UDPTransport& out = r.channel == CaptureChannel::Payload ? payload : ctrl;
+        if (out.send(r.bytes.data(), r.bytes.size())) ++sent;
+        else ++failed;
+    }
+
+    auto elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    std::cout << "[replay] sent=" << sent << " failed=" << failed
+              << " elapsed_s=" << elapsed
+              << " rate=" << (elapsed > 0 ? sent / elapsed : 0) << "/s\n";
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 7) { usage(argv[0]); return 1; }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    const std::string mode = argv[1];
+    if (mode == "capture") return run_capture(argc, argv);
+    if (mode == "replay")  return run_replay(argc, argv);
+    usage(argv[0]);
+    return 1;
+}
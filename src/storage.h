@@ -4,23 +4,28 @@
 #include <string>
 #include <vector>
 #include <map>
-#include <mutex>
+#include <shared_mutex>
+
+#include "shared_buffer.h"
 
 class Storage {
 public:
-    // Append a serialized envelope for (topic, seq).
+    // Append a serialized envelope for (topic, seq). The bytes are shared,
+    // not copied.
     void append(const std::string& topic, uint64_t seq,
-                const std::string& serialized);
+                const SharedBuffer& serialized);
 
     // Return all serialized envelopes for topic in [from, to] inclusive.
-    std::vector<std::string> fetch(const std::string& topic,
-                                   uint64_t from, uint64_t to) const;
+    // Only references are taken under the lock; the bytes stay shared.
+    std::vector<SharedBuffer> fetch(const std::string& topic,
+                                    uint64_t from, uint64_t to) const;
 
     // Return the highest seq seen for topic, or 0 if none.
     uint64_t last_seq(const std::string& topic) const;
 
 private:
-    mutable std::mutex mutex_;
+    // Readers (fetch, last_seq) share the lock; only append is exclusive.
+    mutable std::shared_mutex mutex_;
     // topic -> seq -> serialized envelope
-    std::map<std::string, std::map<uint64_t, std::string>> store_;
+    std::map<std::string, std::map<uint64_t, SharedBuffer>> store_;
 };
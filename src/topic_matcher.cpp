@@ -0,0 +1,126 @@
+#include "topic_matcher.h"
+
+#include <algorithm>
+
+// Cached topics before the cache is dropped and rebuilt on demand; bounds
+// memory when topic names are unbounded (e.g. per-order topics).
+static constexpr size_t MAX_CACHED_TOPICS = 65536;
+
+bool TopicMatcher::split(std::string_view s, std::vector<std::string_view>& out) {
+    out.clear();
+    size_t start = 0;
+    for (;;) {
+        size_t dot = s.find('.', start);
+        std::string_view level = s.substr(start, dot == std::string_view::npos
+                                                     ? std::string_view::npos
+                                                     : dot - start);
+        if (level.empty()) return false;
+        out.push_back(level);
+        if (dot == std::string_view::npos) return true;
+        start = dot + 1;
+    }
+}
+
+SubscriptionId TopicMatcher::add(const std::string& pattern) {
+    std::vector<std::string_view> levels;
+    if (!split(pattern, levels)) return 0;
+    for (size_t i = 0; i + 1 < levels.size(); ++i)
+        if (levels[i] == "#") return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    SubscriptionId id = next_id_++;
+    Node* n = &root_;
+    for (auto level : levels) {
+        if (level == "#") {
+            n->hash.push_back(id);
+            n = nullptr;
+            break;
+        }
+        if (level == "*") {
+            if (!n->star) n->star = std::make_unique<Node>();
+            n = n->star.get();
+            continue;
+        }
+        auto it = n->children.find(level);
+        if (it == n->children.end())
+            it = n->children.emplace(std::string(level), std::make_unique<Node>()).first;
+        n = it->second.get();
+    }
+    if (n) n->here.push_back(id);
+
+    patterns_[id] = pattern;
+    cache_.clear();
+    return id;
+}
+
+void TopicMatcher::remove(SubscriptionId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto pit = patterns_.find(id);
+    if (pit == patterns_.end()) return;
+
+    std::vector<std::string_view> levels;
+    split(pit->second, levels);
+    erase(root_, levels, 0, id);
+
+    patterns_.erase(pit);
+    cache_.clear();
+}
+
+bool TopicMatcher::erase(Node& n, const std::vector<std::string_view>& levels,
+                         size_t i, SubscriptionId id) {
+    auto drop = [id](std::vector<SubscriptionId>& v) {
+        v.erase(std::remove(v.begin(), v.end(), id), v.end());
+    };
+    if (i == levels.size()) {
+        drop(n.here);
+    } else if (levels[i] == "#") {
+        drop(n.hash);
+    } else if (levels[i] == "*") {
+        if (n.star && erase(*n.star, levels, i + 1, id)) n.star.reset();
+    } else {
+        auto it = n.children.find(levels[i]);
+        if (it != n.children.end() && erase(*it->second, levels, i + 1, id))
+            n.children.erase(it);
+    }
+    return n.here.empty() && n.hash.empty() && !n.star && n.children.empty();
+}
+
+TopicMatcher::Matches TopicMatcher::match(std::string_view topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto cit = cache_.find(topic);
+    if (cit != cache_.end()) return cit->second.matches;
+
+    auto ids = std::make_shared<std::vector<SubscriptionId>>();
+    std::vector<std::string_view> levels;
+    if (split(topic, levels)) {
+        collect(root_, levels, 0, *ids);
+        std::sort(ids->begin(), ids->end());
+        ids->erase(std::unique(ids->begin(), ids->end()), ids->end());
+    }
+
+    if (cache_.size() >= MAX_CACHED_TOPICS) cache_.clear();
+    CacheEntry entry{std::make_unique<const std::string>(topic), std::move(ids)};
+    std::string_view key(*entry.topic);
+    Matches result = entry.matches;
+    cache_.emplace(key, std::move(entry));
+    return result;
+}
+
+bool TopicMatcher::empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return patterns_.empty();
+}
+
+void TopicMatcher::collect(const Node& n,
+                           const std::vector<std::string_view>& levels,
+                           size_t i, std::vector<SubscriptionId>& out) const {
+    // "#" matches whatever is left, including nothing.
+    out.insert(out.end(), n.hash.begin(), n.hash.end());
+    if (i == levels.size()) {
+        out.insert(out.end(), n.here.begin(), n.here.end());
+        return;
+    }
+    auto it = n.children.find(levels[i]);
+    if (it != n.children.end()) collect(*it->second, levels, i + 1, out);
+    if (n.star) collect(*n.star, levels, i + 1, out);
+}
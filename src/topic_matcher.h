@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using SubscriptionId = uint64_t;
+
+// Matches dot-separated topics ("md.eq.AAPL") against subscription patterns.
+// In a pattern "*" matches exactly one level and "#" (last level only)
+// matches zero or more trailing levels, so "md.*.AAPL" and "md.fx.#" are
+// valid. Patterns are compiled into a trie; results are cached per topic
+// and the cache is invalidated whenever the subscription set changes.
+class TopicMatcher {
+public:
+    using Matches = std::shared_ptr<const std::vector<SubscriptionId>>;
+
+    // Register pattern. Returns its id, or 0 if the pattern is malformed
+    // (empty level, or "#" anywhere but the last level).
+    SubscriptionId add(const std::string& pattern);
+
+    // Unregister a pattern; unknown ids are ignored.
+    void remove(SubscriptionId id);
+
+    // Ids of all patterns matching topic, sorted ascending. Never null.
+    Matches match(std::string_view topic);
+
+    // True if no patterns are registered.
+    bool empty() const;
+
+private:
+    struct Node {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children;
+        std::unique_ptr<Node>       star;  // "*"
+        std::vector<SubscriptionId> here;  // patterns ending at this node
+        std::vector<SubscriptionId> hash;  // patterns ending in ".#" here
+    };
+
+    // Cached result for one topic. The view keys of cache_ point into topic,
+    // which lives on the heap so the keys survive rehashing.
+    struct CacheEntry {
+        std::unique_ptr<const std::string> topic;
+        Matches                            matches;
+    };
+
+    static bool split(std::string_view s, std::vector<std::string_view>& out);
+    // Remove id from the branch for levels[i..]; returns true if n is left
+    // empty so the caller can prune it.
+    static bool erase(Node& n, const std::vector<std::string_view>& levels,
+                      size_t i, SubscriptionId id);
+    void collect(const Node& n, const std::vector<std::string_view>& levels,
+                 size_t i, std::vector<SubscriptionId>& out) const;
+
+    mutable std::mutex mutex_;
+    Node               root_;
+    SubscriptionId     next_id_{1};
+    std::map<SubscriptionId, std::string> patterns_;
+    // Keyed by string_view so a cache hit costs no allocation.
+    std::unordered_map<std::string_view, CacheEntry> cache_;
+};
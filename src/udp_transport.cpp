@@ -6,15 +6,24 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#if __has_include(<linux/sock_diag.h>)
+#  include <linux/sock_diag.h>
+#  define HAVE_SOCK_DIAG 1
+#endif
+
+#include <cerrno>
 #include <cstring>
+#include <ctime>
 #include <stdexcept>
 
 static constexpr size_t RECV_BUF = 65536;
+// Upper bound on datagrams handled per drain() so one busy socket cannot
+// starve the rest of an event loop; level-triggered epoll reports it again.
+static constexpr size_t DRAIN_BUDGET = 256;
 
 UDPTransport::UDPTransport() = default;
 
 UDPTransport::~UDPTransport() {
-    stop_recv();
     if (send_fd_ >= 0) ::close(send_fd_);
     if (recv_fd_ >= 0) ::close(recv_fd_);
 }
@@ -40,7 +49,8 @@ bool UDPTransport::init_receiver(const std::string& mcast_addr, int port) {
     mcast_addr_ = mcast_addr;
     mcast_port_ = port;
 
-    recv_fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    // Non-blocking so drain() can empty the queue from an event loop.
+    recv_fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
     if (recv_fd_ < 0) return false;
 
     int reuse = 1;
@@ -58,17 +68,45 @@ bool UDPTransport::init_receiver(const std::string& mcast_addr, int port) {
         return false;
     }
 
+    if (!set_membership(true)) {
+        ::close(recv_fd_); recv_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool UDPTransport::set_membership(bool joined) {
+    if (recv_fd_ < 0) return false;
+    if (joined == joined_) return true;
+
     ip_mreq mreq{};
-    mreq.imr_multiaddr.s_addr = ::inet_addr(mcast_addr.c_str());
+    mreq.imr_multiaddr.s_addr = ::inet_addr(mcast_addr_.c_str());
     mreq.imr_interface.s_addr = htonl(INADDR_ANY);
-    if (::setsockopt(recv_fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+    if (::setsockopt(recv_fd_, IPPROTO_IP,
+                     joined ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
                      &mreq, sizeof(mreq)) < 0) {
-        ::close(recv_fd_); recv_fd_ = -1;
         return false;
     }
+    joined_ = joined;
     return true;
 }
 
+double UDPTransport::rx_buffer_fill() const {
+#if defined(SO_MEMINFO) && defined(HAVE_SOCK_DIAG)
+    if (recv_fd_ < 0) return -1;
+    uint32_t mem[SK_MEMINFO_VARS] = {};
+    socklen_t len = sizeof(mem);
+    if (::getsockopt(recv_fd_, SOL_SOCKET, SO_MEMINFO, mem, &len) < 0 ||
+        mem[SK_MEMINFO_RCVBUF] == 0) {
+        return -1;
+    }
+    return static_cast<double>(mem[SK_MEMINFO_RMEM_ALLOC]) /
+           mem[SK_MEMINFO_RCVBUF];
+#else
+    return -1;
+#endif
+}
+
 bool UDPTransport::send(const char* data, size_t len) {
     if (send_fd_ < 0) return false;
 
@@ -82,27 +120,76 @@ bool UDPTransport::send(const char* data, size_t len) {
     return sent == static_cast<ssize_t>(len);
 }
 
-void UDPTransport::start_recv(UdpRecvCallback cb) {
-    if (recv_fd_ < 0) return;
-    running_ = true;
-    recv_thread_ = std::thread([this, cb = std::move(cb)]() {
-        std::vector<char> buf(RECV_BUF);
-        while (running_) {
-            // Use a short timeout so we can check running_.
-            timeval tv{0, 100000}; // 100 ms
-            fd_set fds;
-            FD_ZERO(&fds);
-            FD_SET(recv_fd_, &fds);
-            int r = ::select(recv_fd_ + 1, &fds, nullptr, nullptr, &tv);
-            if (r > 0 && FD_ISSET(recv_fd_, &fds)) {
-                ssize_t n = ::recv(recv_fd_, buf.data(), buf.size(), 0);
-                if (n > 0) cb(buf.data(), static_cast<size_t>(n));
-            }
+size_t UDPTransport::drain(const UdpRecvCallback& cb) {
+    if (recv_fd_ < 0) return 0;
+    if (drain_buf_.empty()) drain_buf_.resize(RECV_BUF);
+    size_t count = 0;
+    while (count < DRAIN_BUDGET) {
+        ssize_t n = ::recv(recv_fd_, drain_buf_.data(), drain_buf_.size(), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break; // EAGAIN: queue empty
         }
-    });
+        if (n > 0) {
+            cb(drain_buf_.data(), static_cast<size_t>(n));
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool UDPTransport::enable_rx_timestamps() {
+#ifdef SO_TIMESTAMPNS
+    if (recv_fd_ < 0) return false;
+    int on = 1;
+    return ::setsockopt(recv_fd_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0;
+#else
+    return false;
+#endif
+}
+
+size_t UDPTransport::drain_timestamped(const UdpTimedRecvCallback& cb) {
+    if (recv_fd_ < 0) return 0;
+    if (drain_buf_.empty()) drain_buf_.resize(RECV_BUF);
+    size_t count = 0;
+    while (count < DRAIN_BUDGET) {
+        iovec iov{drain_buf_.data(), drain_buf_.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+        msghdr msg{};
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t n = ::recvmsg(recv_fd_, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break; // EAGAIN: queue empty
+        }
+        if (n == 0) continue;
+
+        uint64_t rx_ns = 0;
+#ifdef SO_TIMESTAMPNS
+        for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_TIMESTAMPNS) continue;
+            timespec ts;
+            std::memcpy(&ts, CMSG_DATA(c), sizeof(ts));
+            rx_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+                    static_cast<uint64_t>(ts.tv_nsec);
+        }
+#endif
+        cb(drain_buf_.data(), static_cast<size_t>(n), rx_ns);
+        ++count;
+    }
+    return count;
 }
 
-void UDPTransport::stop_recv() {
-    running_ = false;
-    if (recv_thread_.joinable()) recv_thread_.join();
+bool UDPTransport::set_busy_poll(int usec) {
+#ifdef SO_BUSY_POLL
+    if (recv_fd_ < 0) return false;
+    return ::setsockopt(recv_fd_, SOL_SOCKET, SO_BUSY_POLL,
+                        &usec, sizeof(usec)) == 0;
+#else
+    (void)usec;
+    return false;
+#endif
 }
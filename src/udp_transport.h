@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <string>
-#include <thread>
-#include <atomic>
+#include <vector>
 
 using UdpRecvCallback = std::function<void(const char*, size_t)>;
+// As UdpRecvCallback, plus the kernel's receive time in ns since the Unix
+// epoch, or 0 if the datagram carried no timestamp.
+using UdpTimedRecvCallback = std::function<void(const char*, size_t, uint64_t rx_wall_ns)>;
 
 class UDPTransport {
 public:
@@ -21,18 +24,39 @@ public:
     // Send raw bytes via the sender socket.
     bool send(const char* data, size_t len);
 
-    // Start background receive thread; invokes cb for every datagram.
-    void start_recv(UdpRecvCallback cb);
+    // Receiving socket, for registration with an EventLoop (-1 if not open).
+    int recv_fd() const { return recv_fd_; }
 
-    // Stop the background receive thread.
-    void stop_recv();
+    // Read the datagrams currently queued on the (non-blocking) receiving
+    // socket, up to a fixed budget, and invoke cb for each. Returns the
+    // number delivered.
+    size_t drain(const UdpRecvCallback& cb);
+
+    // Ask the kernel to timestamp datagrams on arrival (SO_TIMESTAMPNS).
+    // Returns false if the option is unavailable.
+    bool enable_rx_timestamps();
+
+    // drain() for sockets with rx timestamps enabled: reads each datagram
+    // with recvmsg and passes on its arrival time.
+    size_t drain_timestamped(const UdpTimedRecvCallback& cb);
+
+    // Fraction (0..1) of the receiving socket's buffer currently in use, or
+    // -1 if the kernel does not expose it (SO_MEMINFO).
+    double rx_buffer_fill() const;
+
+    // Join or leave the receiving socket's multicast group. The socket stays
+    // open, so joining again resumes delivery.
+    bool set_membership(bool joined);
+
+    // Enable SO_BUSY_POLL on the receiving socket. Returns false if the
+    // kernel rejects it (older kernels, or missing CAP_NET_ADMIN).
+    bool set_busy_poll(int usec);
 
 private:
     std::string mcast_addr_;
     int         mcast_port_{0};
     int         send_fd_{-1};
     int         recv_fd_{-1};
-
-    std::atomic<bool> running_{false};
-    std::thread       recv_thread_;
+    bool        joined_{false};
+    std::vector<char> drain_buf_;
 };
@@ -2,6 +2,50 @@
 
 #include <zmq.hpp>
 #include <iostream>
+#include <memory>
+
+// zmq free callback: drops the reference that kept a frame's bytes alive.
+static void release_buffer(void* /*data*/, void* hint) {
+    delete static_cast<SharedBuffer*>(hint);
+}
+
+// Wrap buf in a message that points at its bytes instead of copying them.
+static zmq::message_t zero_copy_message(const SharedBuffer& buf) {
+    if (buf.empty()) return zmq::message_t();
+    auto* hold = new SharedBuffer(buf);
+    return zmq::message_t(const_cast<char*>(hold->data()), hold->size(),
+                          release_buffer, hold);
+}
+
+static void send_frames(zmq::socket_t& sock,
+                        const std::vector<SharedBuffer>& frames) {
+    if (frames.empty()) {
+        sock.send(zmq::message_t(), zmq::send_flags::none);
+        return;
+    }
+    for (size_t i = 0; i < frames.size(); ++i) {
+        auto flags = i + 1 < frames.size() ? zmq::send_flags::sndmore
+                                           : zmq::send_flags::none;
+        sock.send(zero_copy_message(frames[i]), flags);
+    }
+}
+
+// Receive one (possibly multipart) reply. Each part stays in the message
+// zmq received it into; the buffers own those messages, so nothing is
+// copied or joined.
+static bool recv_frames(zmq::socket_t& sock, std::vector<SharedBuffer>& out) {
+    auto flags = zmq::recv_flags::dontwait;
+    for (;;) {
+        auto part = std::make_shared<zmq::message_t>();
+        if (!sock.recv(*part, flags)) return false;
+        bool more = part->more();
+        const char* data = static_cast<const char*>(part->data());
+        out.push_back(SharedBuffer::wrap(part, data, part->size()));
+        if (!more) return true;
+        // Remaining parts of a multipart message are already queued.
+        flags = zmq::recv_flags::none;
+    }
+}
 
 ZMQFetch::ZMQFetch() = default;
 
@@ -9,52 +53,102 @@ ZMQFetch::~ZMQFetch() {
     stop_server();
 }
 
-void ZMQFetch::start_server(const std::string& zmq_bind_addr,
+bool ZMQFetch::start_server(EventLoop& loop, const std::string& zmq_bind_addr,
                              ZmqServerHandler handler) {
     bind_addr_ = zmq_bind_addr;
-    running_   = true;
-    server_thread_ = std::thread([this, handler = std::move(handler)]() {
-        zmq::context_t ctx(1);
-        zmq::socket_t  sock(ctx, zmq::socket_type::rep);
-        sock.bind(bind_addr_);
-        sock.set(zmq::sockopt::rcvtimeo, 200); // 200 ms poll interval
-        while (running_) {
-            zmq::message_t req;
-            auto result = sock.recv(req, zmq::recv_flags::none);
-            if (!result) continue; // timeout
-            std::string req_str(static_cast<char*>(req.data()), req.size());
-            std::string resp_str = handler(req_str);
-            zmq::message_t rep(resp_str.size());
-            std::memcpy(rep.data(), resp_str.data(), resp_str.size());
-            sock.send(rep, zmq::send_flags::none);
-        }
-    });
+    try {
+        ensure_context();
+        server_sock_ = std::make_unique<zmq::socket_t>(*ctx_, zmq::socket_type::rep);
+        server_sock_->set(zmq::sockopt::linger, 0);
+        server_sock_->bind(bind_addr_);
+        server_fd_ = static_cast<int>(server_sock_->get(zmq::sockopt::fd));
+    } catch (const zmq::error_t& e) {
+        std::cerr << "[ZMQFetch] bind error: " << e.what() << '\n';
+        server_sock_.reset();
+        return false;
+    }
+    loop_    = &loop;
+    handler_ = std::move(handler);
+    loop.add_fd(server_fd_, [this]{ on_server_readable(); });
+    // ZMQ_FD only signals state changes; pick up anything already queued.
+    loop.post([this]{ on_server_readable(); });
+    return true;
 }
 
 void ZMQFetch::stop_server() {
-    running_ = false;
-    if (server_thread_.joinable()) server_thread_.join();
+    if (loop_) {
+        if (server_sock_) loop_->remove_fd(server_fd_);
+        for (auto& [fd, p] : pending_) {
+            loop_->remove_fd(fd);
+            loop_->cancel_timer(p.deadline);
+        }
+    }
+    pending_.clear();
+    server_sock_.reset();
+    server_fd_ = -1;
 }
 
-std::string ZMQFetch::fetch_from(const std::string& zmq_addr,
-                                  const std::string& serialized_request) {
+void ZMQFetch::fetch_async(EventLoop& loop, const std::string& zmq_addr,
+                           const std::string& serialized_request,
+                           std::chrono::milliseconds timeout,
+                           ZmqFetchCallback cb) {
+    int fd = -1;
     try {
-        zmq::context_t ctx(1);
-        zmq::socket_t  sock(ctx, zmq::socket_type::req);
-        sock.set(zmq::sockopt::rcvtimeo, 2000); // 2 s timeout
-        sock.connect(zmq_addr);
-
-        zmq::message_t req(serialized_request.size());
-        std::memcpy(req.data(), serialized_request.data(),
-                    serialized_request.size());
-        sock.send(req, zmq::send_flags::none);
-
-        zmq::message_t rep;
-        auto result = sock.recv(rep, zmq::recv_flags::none);
-        if (!result) return {};
-        return {static_cast<char*>(rep.data()), rep.size()};
+        ensure_context();
+        auto sock = std::make_unique<zmq::socket_t>(*ctx_, zmq::socket_type::req);
+        sock->set(zmq::sockopt::linger, 0);
+        sock->connect(zmq_addr);
+
+        zmq::message_t req(serialized_request.data(), serialized_request.size());
+        if (!sock->send(req, zmq::send_flags::dontwait)) {
+            cb({});
+            return;
+        }
+        fd = static_cast<int>(sock->get(zmq::sockopt::fd));
+        loop_ = &loop;
+        TimerId deadline = loop.add_timer(timeout, [this, fd]{ finish_fetch(fd, {}); });
+        pending_[fd] = PendingFetch{std::move(sock), deadline, std::move(cb)};
     } catch (const zmq::error_t& e) {
         std::cerr << "[ZMQFetch] error: " << e.what() << '\n';
-        return {};
+        cb({});
+        return;
+    }
+    loop.add_fd(fd, [this, fd]{ on_fetch_readable(fd); });
+    on_fetch_readable(fd);
+}
+
+void ZMQFetch::ensure_context() {
+    if (!ctx_) ctx_ = std::make_unique<zmq::context_t>(1);
+}
+
+void ZMQFetch::on_server_readable() {
+    if (!server_sock_) return;
+    // ZMQ_FD is edge-like: keep serving until ZMQ_EVENTS reports no input.
+    while (server_sock_->get(zmq::sockopt::events) & ZMQ_POLLIN) {
+        zmq::message_t req;
+        if (!server_sock_->recv(req, zmq::recv_flags::dontwait)) break;
+        std::string req_str(static_cast<char*>(req.data()), req.size());
+        send_frames(*server_sock_, handler_(req_str));
     }
 }
+
+void ZMQFetch::on_fetch_readable(int fd) {
+    auto it = pending_.find(fd);
+    if (it == pending_.end()) return;
+    zmq::socket_t& sock = *it->second.sock;
+    if (!(sock.get(zmq::sockopt::events) & ZMQ_POLLIN)) return;
+
+    std::vector<SharedBuffer> frames;
+    if (!recv_frames(sock, frames)) return;
+    finish_fetch(fd, frames);
+}
+
+void ZMQFetch::finish_fetch(int fd, const std::vector<SharedBuffer>& frames) {
+    auto it = pending_.find(fd);
+    if (it == pending_.end()) return;
+    loop_->remove_fd(fd);
+    loop_->cancel_timer(it->second.deadline);
+    ZmqFetchCallback cb = std::move(it->second.cb);
+    pending_.erase(it); // closes the REQ socket
+    cb(frames);
+}
@@ -1,35 +1,72 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <map>
+#include <memory>
 #include <string>
-#include <thread>
-#include <atomic>
+#include <vector>
+
+#include "event_loop.h"
+#include "shared_buffer.h"
+
+// Forward-declared to keep <zmq.hpp> out of this header.
+namespace zmq { class context_t; class socket_t; }
 
 // Handler signature for the ZMQ server: receives a serialised FetchRequest,
-// returns a serialised FetchResponse.
+// returns a serialised FetchResponse split into frames whose concatenation
+// is the full message. Each frame goes out as one part of a multipart reply
+// without being copied; return a single frame for clients that expect a
+// single-part reply.
 using ZmqServerHandler =
-    std::function<std::string(const std::string& serialized_req)>;
+    std::function<std::vector<SharedBuffer>(const std::string& serialized_req)>;
+
+// Completion for fetch_async: the parts of the multipart reply, in order,
+// or no parts on error or timeout.
+using ZmqFetchCallback = std::function<void(const std::vector<SharedBuffer>& frames)>;
 
 class ZMQFetch {
 public:
     ZMQFetch();
     ~ZMQFetch();
 
-    // Start a ZMQ REP server on zmq_bind_addr (e.g. "tcp://*:5555").
-    // handler is called in the server thread for each request.
-    void start_server(const std::string& zmq_bind_addr,
+    // Start a ZMQ REP server on zmq_bind_addr (e.g. "tcp://*:5555"),
+    // served from loop's thread via ZMQ_FD. handler is called on the loop
+    // thread for each request.
+    bool start_server(EventLoop& loop, const std::string& zmq_bind_addr,
                       ZmqServerHandler handler);
 
-    // Stop the server thread.
+    // Release the server socket and any in-flight fetch_async requests.
+    // Call only after the loop has stopped.
     void stop_server();
 
-    // Synchronous fetch from a peer's ZMQ REP endpoint.
-    // Returns the raw serialised FetchResponse, or empty on error.
-    std::string fetch_from(const std::string& zmq_addr,
-                           const std::string& serialized_request);
+    // Non-blocking fetch driven by loop; cb runs on the loop thread exactly
+    // once, with no frames if no reply arrives within timeout.
+    // Must be called on the loop thread.
+    void fetch_async(EventLoop& loop, const std::string& zmq_addr,
+                     const std::string& serialized_request,
+                     std::chrono::milliseconds timeout, ZmqFetchCallback cb);
 
 private:
-    std::atomic<bool> running_{false};
-    std::thread       server_thread_;
-    std::string       bind_addr_;
+    struct PendingFetch {
+        std::unique_ptr<zmq::socket_t> sock;
+        TimerId                        deadline{0};
+        ZmqFetchCallback               cb;
+    };
+
+    void ensure_context();
+    void on_server_readable();
+    void on_fetch_readable(int fd);
+    void finish_fetch(int fd, const std::vector<SharedBuffer>& frames);
+
+    std::string bind_addr_;
+
+    // ctx_ is declared first so sockets are closed before it.
+    EventLoop*                      loop_{nullptr};
+    std::unique_ptr<zmq::context_t> ctx_;
+    std::unique_ptr<zmq::socket_t>  server_sock_;
+    int                             server_fd_{-1};
+    ZmqServerHandler                handler_;
+    // ZMQ_FD of each in-flight request socket -> request state.
+    std::map<int, PendingFetch>     pending_;
 };
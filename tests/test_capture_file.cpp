@@ -0,0 +1,39 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "capture_file.h"
+
+TEST_CASE("capture file round-trips records and timestamps") {
+    const std::string path = "test_capture_file.cap";
+    CaptureWriter w;
+    REQUIRE(w.open(path, 1234567890123ull));
+    REQUIRE(w.write(0,          CaptureChannel::Payload, "a", 1));
+    REQUIRE(w.write(1500,       CaptureChannel::Control, "hb", 2));
+    REQUIRE(w.write(3000000000, CaptureChannel::Payload, std::string(300, 'x').data(), 300));
+    REQUIRE(w.records() == 3);
+    REQUIRE(w.close());
+
+    std::vector<CaptureRecord> records;
+    uint64_t start = 0;
+    REQUIRE(load_capture(path, records, &start));
+    REQUIRE(start == 1234567890123ull);
+    REQUIRE(records.size() == 3);
+    REQUIRE(records[1].t_ns == 1500);
+    REQUIRE(records[1].channel == CaptureChannel::Control);
+    REQUIRE(records[1].bytes == "hb");
+    REQUIRE(records[2].t_ns == 3000000000);
+    REQUIRE(records[2].bytes.size() == 300);
+
+    // A truncated file is rejected rather than silently shortened.
+    std::ofstream(path, std::ios::binary | std::ios::app) << '\x05';
+    REQUIRE_FALSE(load_capture(path, records));
+    // So is a length running past the end of the file.
+    std::ofstream(path, std::ios::binary | std::ios::app) << '\x00' << "\xff\xff\xff\xff\x0f";
+    REQUIRE_FALSE(load_capture(path, records));
+
+    std::remove(path.c_str());
+}
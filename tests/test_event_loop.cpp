@@ -0,0 +1,34 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include "event_loop.h"
+
+TEST_CASE("event loop fires timers and posted tasks") {
+    EventLoop loop;
+    int oneshot = 0, cancelled = 0, periodic = 0, posted = 0;
+
+    loop.add_timer(std::chrono::milliseconds(5), [&]{ ++oneshot; });
+    TimerId id = loop.add_timer(std::chrono::milliseconds(5), [&]{ ++cancelled; });
+    loop.cancel_timer(id);
+    loop.add_periodic_timer(std::chrono::milliseconds(5), [&]{ ++periodic; });
+    loop.add_timer(std::chrono::milliseconds(40), [&]{ loop.stop(); });
+    loop.post([&]{ ++posted; });
+
+    loop.run();
+
+    REQUIRE(oneshot == 1);
+    REQUIRE(cancelled == 0);
+    REQUIRE(periodic >= 2);
+    REQUIRE(posted == 1);
+}
+
+TEST_CASE("event loop stop wakes a sleeping thread") {
+    EventLoop loop;
+    loop.start_thread();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto t0 = std::chrono::steady_clock::now();
+    loop.stop();
+    REQUIRE(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(1));
+}
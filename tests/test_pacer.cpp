@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+
+#include "pacer.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("pacer allows a burst and then spaces sends at the rate") {
+    Pacer pacer(1000, 3); // 1 message/ms, burst of 3
+    auto t0 = Pacer::Clock::now() + 1s; // after construction, so refill is deterministic
+
+    // The bucket starts full (plus any refill up to burst).
+    REQUIRE(pacer.reserve(t0) == Pacer::Clock::duration::zero());
+    REQUIRE(pacer.reserve(t0) == Pacer::Clock::duration::zero());
+    REQUIRE(pacer.reserve(t0) == Pacer::Clock::duration::zero());
+
+    // Empty: the next two callers wait one and two token intervals.
+    auto w1 = pacer.reserve(t0);
+    auto w2 = pacer.reserve(t0);
+    REQUIRE(w1 > 900us);
+    REQUIRE(w1 < 1100us);
+    REQUIRE(w2 > 1900us);
+    REQUIRE(w2 < 2100us);
+
+    // Tokens refill with time but never beyond the burst size.
+    auto later = t0 + 1s;
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(pacer.reserve(later) == Pacer::Clock::duration::zero());
+    REQUIRE(pacer.reserve(later) > Pacer::Clock::duration::zero());
+}
+
+TEST_CASE("pacer with rate 0 never waits") {
+    Pacer pacer;
+    auto now = Pacer::Clock::now();
+    for (int i = 0; i < 1000; ++i)
+        REQUIRE(pacer.reserve(now) == Pacer::Clock::duration::zero());
+}
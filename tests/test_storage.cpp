@@ -0,0 +1,37 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "storage.h"
+
+TEST_CASE("storage shares appended buffers with fetch results") {
+    Storage storage;
+    SharedBuffer one = SharedBuffer::copy("one", 3);
+    SharedBuffer two = SharedBuffer::adopt(std::string("two"));
+
+    storage.append("t", 1, one);
+    storage.append("t", 2, two);
+    REQUIRE(storage.last_seq("t") == 2);
+    REQUIRE(storage.last_seq("other") == 0);
+
+    auto fetched = storage.fetch("t", 1, 5);
+    REQUIRE(fetched.size() == 2);
+    REQUIRE(fetched[0].view() == "one");
+    REQUIRE(fetched[1].view() == "two");
+    // Same bytes, not copies.
+    REQUIRE(fetched[0].data() == one.data());
+    REQUIRE(one.use_count() == 3); // ours, storage's, fetched[0]
+
+    REQUIRE(storage.fetch("t", 3, 5).empty());
+}
+
+TEST_CASE("storage keeps slices of a wrapped buffer alive") {
+    Storage storage;
+    {
+        auto owner = std::make_shared<const std::string>("\x0A\x03" "abc");
+        SharedBuffer frame = SharedBuffer::wrap(owner, owner->data(), owner->size());
+        storage.append("t", 1, frame.slice(2, 3));
+    }
+    auto fetched = storage.fetch("t", 1, 1);
+    REQUIRE(fetched.size() == 1);
+    REQUIRE(fetched[0].view() == "abc");
+    REQUIRE(fetched[0].use_count() == 2); // storage's and fetched[0]
+}
@@ -0,0 +1,56 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "topic_matcher.h"
+
+TEST_CASE("topic matcher handles exact and wildcard patterns") {
+    TopicMatcher m;
+    REQUIRE(m.empty());
+
+    SubscriptionId exact = m.add("md.eq.AAPL");
+    SubscriptionId star  = m.add("md.*.AAPL");
+    SubscriptionId hash  = m.add("md.fx.#");
+    REQUIRE(exact != 0);
+
+    REQUIRE(*m.match("md.eq.AAPL") == std::vector<SubscriptionId>{exact, star});
+    REQUIRE(*m.match("md.fx.AAPL") == std::vector<SubscriptionId>{star, hash});
+    REQUIRE(*m.match("md.fx")      == std::vector<SubscriptionId>{hash});
+    REQUIRE(*m.match("md.fx.EUR.USD") == std::vector<SubscriptionId>{hash});
+    REQUIRE(m.match("md.eq.MSFT")->empty());
+    REQUIRE(m.match("md.eq")->empty());
+}
+
+TEST_CASE("topic matcher rejects malformed patterns") {
+    TopicMatcher m;
+    REQUIRE(m.add("") == 0);
+    REQUIRE(m.add("md..AAPL") == 0);
+    REQUIRE(m.add("md.#.AAPL") == 0);
+    REQUIRE(m.empty());
+}
+
+TEST_CASE("topic matcher invalidates cached matches on change") {
+    TopicMatcher m;
+    SubscriptionId all = m.add("#");
+    REQUIRE(*m.match("a.b") == std::vector<SubscriptionId>{all});
+
+    m.remove(all);
+    REQUIRE(m.match("a.b")->empty());
+    REQUIRE(m.empty());
+
+    SubscriptionId ab = m.add("a.b");
+    REQUIRE(*m.match("a.b") == std::vector<SubscriptionId>{ab});
+}
+
+TEST_CASE("topic matcher prunes removed branches") {
+    TopicMatcher m;
+    SubscriptionId keep = m.add("md.eq.AAPL");
+    for (int i = 0; i < 100; ++i) {
+        SubscriptionId tmp = m.add("md.*.x" + std::to_string(i) + ".#");
+        m.remove(tmp);
+    }
+    REQUIRE(*m.match("md.eq.AAPL") == std::vector<SubscriptionId>{keep});
+    REQUIRE(m.match("md.fx.x5.y")->empty());
+
+    // Re-adding after a prune rebuilds the branch.
+    SubscriptionId again = m.add("md.*.x5.#");
+    REQUIRE(*m.match("md.fx.x5.y") == std::vector<SubscriptionId>{again});
+}